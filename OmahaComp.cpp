@@ -1,17 +1,34 @@
 #include "Poker.h"
+#include "PokerRange.h"
+#include "PokerStats.h"
+#include "PipelineStream.h"
 #include <iostream>
-#include <fstream>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <mutex>
 
-bool LoadCards(const std::string& s, Poker::PokerPlayerCards& h1, Poker::PokerPlayerCards& h2, Poker::PokerBoardCards& b)
+bool SplitCards(const std::string& s, std::string& s1, std::string& s2, std::string& sb)
 {
 	std::string::size_type idx1 = s.find(' ');
 	if (idx1 == std::string::npos)	return false;
 	std::string::size_type idx2 = s.find(' ', idx1 + 1);
 	if (idx2 == std::string::npos)	return false;
 
-	h1 = Poker::PokerPlayerCards(s.substr(0, idx1));
-	h2 = Poker::PokerPlayerCards(s.substr(idx1 + 1, idx2 - idx1 - 1));
-	b  = Poker::PokerBoardCards(s.substr(idx2 + 1, s.length() - idx2));
+	s1 = s.substr(0, idx1);
+	s2 = s.substr(idx1 + 1, idx2 - idx1 - 1);
+	sb = s.substr(idx2 + 1, s.length() - idx2);
+	return true;
+}
+
+bool LoadCards(const std::string& s, Poker::PokerPlayerCards& h1, Poker::PokerPlayerCards& h2, Poker::PokerBoardCards& b)
+{
+	std::string s1, s2, sb;
+	if (!SplitCards(s, s1, s2, sb)) return false;
+
+	h1 = Poker::PokerPlayerCards(s1);
+	h2 = Poker::PokerPlayerCards(s2);
+	b  = Poker::PokerBoardCards(sb);
 	return h1.Cards() == 4 && h2.Cards() == 4 && b.Cards() == 5 ? true : false;
 }
 
@@ -33,32 +50,331 @@ std::string HandEvaluation(const Poker::PokerHand& h1, const Poker::PokerHand& h
 	}
 }
 
-// ---------------------------------------------------------------------------------------------------------
+std::string DealEvaluation(const Poker::PokerHandHigh& hi1, const Poker::PokerHandHigh& hi2, const Poker::PokerHandLow& lo1, const Poker::PokerHandLow& lo2)
+{
+	//  std::cout << "A: " << hi1 << std::endl << "B: " << hi2 << std::endl; // for testing
+	return "=> " + HandEvaluation(hi1, hi2) + "; " + HandEvaluation(lo1, lo2);
+}
 
-int main(int argc, char* argv[])
+std::string DealEvaluation(const Poker::PokerPlayerCards& p1, const Poker::PokerPlayerCards& p2, const Poker::PokerBoardPrepared& b)
 {
-	if (argc < 3)
+	return DealEvaluation(Poker::PokerHandHigh(p1, b), Poker::PokerHandHigh(p2, b), Poker::PokerHandLow(p1, b), Poker::PokerHandLow(p2, b));
+}
+
+int SequentialEvaluation(std::istream& ifs, std::ostream& ofs)
+{
+	Poker::PokerPlayerCards p1, p2;
+	Poker::PokerBoardCards b;
+	std::string sCardCombination;
+
+	while (!ifs.eof())
 	{
-		std::cerr << "Missing application parameters." << std::endl;
-		return EXIT_FAILURE;
+		std::getline(ifs, sCardCombination);
+		if (sCardCombination.empty()) continue;
+
+		if (!LoadCards(sCardCombination, p1, p2, b))
+		{
+			std::cerr << "Wrong syntax in the input file." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		ofs << p1 << ' ' << p2 << ' ' << b << std::endl
+			<< DealEvaluation(p1, p2, Poker::PokerBoardPrepared(b)) << std::endl << std::endl;
 	}
+	return EXIT_SUCCESS;
+}
 
-	std::ifstream ifs(argv[1]);
-	if (!ifs)
+// Evaluates a hand once per prepared board: hands with the same hole cards (e.g. re-runs) share
+// one entry. Returns the index of the hand's Hi/Lo evaluation.
+std::size_t CachedEvaluation(const Poker::PokerPlayerCards& p, const Poker::PokerBoardPrepared& b, 
+	std::unordered_map<unsigned long long, std::size_t>& handIndex, std::vector<Poker::PokerHandHigh>& highs, std::vector<Poker::PokerHandLow>& lows)
+{
+	unsigned long long nMask = 0;
+	for (unsigned int i = 0; i < p.Cards(); i++)
 	{
-		std::cerr << "Cannot find the specified input file." << std::endl;
-		return EXIT_FAILURE;
+		int n = p[i].GetCardIndex();
+		if (n < 0 || nMask & 1ULL << n) { nMask = 0; break; } // not cached
+		nMask |= 1ULL << n;
 	}
 
-	std::ofstream ofs;
-	ofs.open(argv[2]);
-	if (!ofs)
+	if (nMask)
 	{
-		std::cerr << "Cannot open the specified output file." << std::endl;
+		std::unordered_map<unsigned long long, std::size_t>::iterator it = handIndex.find(nMask);
+		if (it != handIndex.end()) return it->second;
+		handIndex[nMask] = highs.size();
+	}
+	highs.push_back(Poker::PokerHandHigh(p, b));
+	lows.push_back(Poker::PokerHandLow(p, b));
+	return highs.size() - 1;
+}
+
+// Lines are read in chunks and bucketed by the board text. Each distinct board is parsed and prepared
+// once per chunk and, within a bucket, each distinct set of hole cards is evaluated once; the results
+// are written back in the input order.
+int BatchEvaluation(std::istream& ifs, std::ostream& ofs)
+{
+	typedef std::vector<std::string>::size_type Index;
+	const Index nChunkLines = 1 << 14;
+	std::vector<Poker::PokerPlayerCards> hands1, hands2;
+	std::vector<Index> group, first, order;
+	std::vector<std::string> boards, results;
+	std::unordered_map<std::string, Index> boardIndex;
+	std::unordered_map<unsigned long long, std::size_t> handIndex;
+	std::vector<Poker::PokerHandHigh> highs;
+	std::vector<Poker::PokerHandLow> lows;
+	std::string sCardCombination, s1, s2, sb;
+
+	while (!ifs.eof())
+	{
+		hands1.clear();
+		hands2.clear();
+		group.clear();
+		boards.clear();
+		boardIndex.clear();
+		while (group.size() < nChunkLines && std::getline(ifs, sCardCombination))
+		{
+			if (sCardCombination.empty()) continue;
+
+			if (!SplitCards(sCardCombination, s1, s2, sb))
+			{
+				std::cerr << "Wrong syntax in the input file." << std::endl;
+				return EXIT_FAILURE;
+			}
+			hands1.push_back(Poker::PokerPlayerCards(s1));
+			hands2.push_back(Poker::PokerPlayerCards(s2));
+			if (hands1.back().Cards() != 4 || hands2.back().Cards() != 4)
+			{
+				std::cerr << "Wrong syntax in the input file." << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			std::unordered_map<std::string, Index>::iterator it = boardIndex.find(sb);
+			if (it == boardIndex.end())
+			{
+				it = boardIndex.insert(std::make_pair(sb, boards.size())).first;
+				boards.push_back(sb);
+			}
+			group.push_back(it->second);
+		}
+
+		// Stable bucket sort of the line numbers by board
+		first.assign(boards.size() + 1, 0);
+		order.resize(group.size());
+		for (Index i = 0; i < group.size(); i++)
+			first[group[i] + 1]++;
+		for (Index g = 0; g < boards.size(); g++)
+			first[g + 1] += first[g];
+		for (Index i = 0; i < group.size(); i++)
+			order[first[group[i]]++] = i;
+
+		results.assign(group.size(), std::string());
+		for (Index g = 0, k = 0; g < boards.size(); g++)
+		{
+			Poker::PokerBoardCards b(boards[g]);
+			if (b.Cards() != 5)
+			{
+				std::cerr << "Wrong syntax in the input file." << std::endl;
+				return EXIT_FAILURE;
+			}
+			Poker::PokerBoardPrepared pb(b);
+			std::string sBoard = b.ToString();
+
+			handIndex.clear();
+			highs.clear();
+			lows.clear();
+			for (; k < group.size() && group[order[k]] == g; k++)
+			{
+				Index i = order[k];
+				std::size_t h1 = CachedEvaluation(hands1[i], pb, handIndex, highs, lows);
+				std::size_t h2 = CachedEvaluation(hands2[i], pb, handIndex, highs, lows);
+				results[i] = hands1[i].ToString() + ' ' + hands2[i].ToString() + ' ' + sBoard + '\n'
+					+ DealEvaluation(highs[h1], highs[h2], lows[h1], lows[h2]);
+			}
+		}
+
+		for (Index i = 0; i < results.size(); i++)
+			ofs << results[i] << std::endl << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
+
+bool PairsLowCard(const Poker::PokerCard& c, const Poker::PokerPlayerCards& p)
+{
+	Poker::PokerCard low(c);
+	low.transformForLow8();
+	if (!low.IsLow8()) return false;
+
+	for (unsigned int i = 0; i < p.Cards(); i++)
+	{
+		Poker::PokerCard pc(p[i]);
+		pc.transformForLow8();
+		if (pc == low) return true;
+	}
+	return false;
+}
+
+// For a flop or turn board every unseen card is tried as the next board card. The prepared board
+// and both hands' partial evaluations are extended by that card instead of being rebuilt.
+int OutsEvaluation(std::istream& ifs, std::ostream& ofs)
+{
+	std::vector<Poker::PokerCard> deck;
+	for (const char* r = "23456789TJQKA"; *r; r++)
+		for (const char* s = "dchs"; *s; s++)
+			deck.push_back(Poker::PokerCard(std::string(1, *r) + *s));
+
+	enum { outs_a_hi, outs_b_hi, outs_a_lo, outs_b_lo, counterfeit_a_lo, counterfeit_b_lo, outs_lists };
+	const char* sOutsNames[outs_lists] = { "HandA Hi outs", "HandB Hi outs", "HandA Lo outs", "HandB Lo outs", 
+										   "HandA Lo counterfeits", "HandB Lo counterfeits" };
+	std::string sCardCombination, s1, s2, sb;
+
+	while (!ifs.eof())
+	{
+		std::getline(ifs, sCardCombination);
+		if (sCardCombination.empty()) continue;
+
+		bool bValid = SplitCards(sCardCombination, s1, s2, sb);
+		Poker::PokerPlayerCards p1(s1), p2(s2);
+		Poker::PokerBoardCards b(sb);
+		unsigned long long nUsed = 0;
+		const Poker::PokerCardSet* sets[] = { &p1, &p2, &b };
+		for (unsigned int i = 0; bValid && i < 3; i++)
+			for (unsigned int j = 0; bValid && j < sets[i]->Cards(); j++)
+			{
+				int n = (*sets[i])[j].GetCardIndex();
+				bValid = n >= 0 && !(nUsed & 1ULL << n);
+				nUsed |= 1ULL << (n & 63);
+			}
+
+		if (!bValid || p1.Cards() != 4 || p2.Cards() != 4 || b.Cards() < 3 || b.Cards() > 4)
+		{
+			std::cerr << "Wrong syntax in the input file." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Poker::PokerBoardPrepared pb(b);
+		Poker::PokerHandHigh hi1(p1, pb), hi2(p2, pb);
+		Poker::PokerHandLow lo1(p1, pb), lo2(p2, pb);
+		int nHi = Poker::HandComparison(hi1, hi2), nLo = Poker::HandComparison(lo1, lo2);
+
+		ofs << p1 << ' ' << p2 << ' ' << b << std::endl
+			<< "=> " << HandEvaluation(hi1, hi2) << "; " << HandEvaluation(lo1, lo2) << std::endl;
+
+		std::string sOuts[outs_lists];
+		for (std::vector<Poker::PokerCard>::size_type i = 0; i < deck.size(); i++)
+		{
+			const Poker::PokerCard& c = deck[i];
+			if (nUsed & 1ULL << c.GetCardIndex()) continue;
+
+			Poker::PokerBoardPrepared nb(pb, c);
+			Poker::PokerHandHigh nhi1(hi1, p1, nb), nhi2(hi2, p2, nb);
+			Poker::PokerHandLow nlo1(lo1, p1, nb), nlo2(lo2, p2, nb);
+			int nNewHi = Poker::HandComparison(nhi1, nhi2), nNewLo = Poker::HandComparison(nlo1, nlo2);
+
+			ofs << c << " => " << HandEvaluation(nhi1, nhi2) << "; " << HandEvaluation(nlo1, nlo2) << std::endl;
+
+			std::string sCard = ' ' + c.ToString();
+			if (nNewHi == 1 && nHi != 1) sOuts[outs_a_hi] += sCard;
+			if (nNewHi == -1 && nHi != -1) sOuts[outs_b_hi] += sCard;
+			if (nNewLo == 1 && nLo != 1) sOuts[outs_a_lo] += sCard;
+			if (nNewLo == -1 && nLo != -1) sOuts[outs_b_lo] += sCard;
+			if (lo1.qualified() && nNewLo < nLo && PairsLowCard(c, p1)) sOuts[counterfeit_a_lo] += sCard;
+			if (lo2.qualified() && nNewLo > nLo && PairsLowCard(c, p2)) sOuts[counterfeit_b_lo] += sCard;
+		}
+
+		for (int i = 0; i < outs_lists; i++)
+			ofs << sOutsNames[i] << ':' << (sOuts[i].empty() ? " none" : sOuts[i]) << std::endl;
+		ofs << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
+
+// Deals are handed to worker threads in chunks; each worker keeps its own counters on its stack,
+// which are merged into the total once its chunks are done, and no per-line text is produced.
+int StatsEvaluation(std::istream& ifs, std::ostream& ofs)
+{
+	const std::vector<std::string>::size_type nChunkLines = 1 << 12;
+	unsigned int nWorkers = std::max(1u, std::thread::hardware_concurrency());
+	Pipeline::BoundedQueue<std::vector<std::string>> chunks(2 * nWorkers);
+	Poker::PokerDealStats total;
+	std::mutex mTotal;
+	std::vector<std::thread> workers;
+	std::atomic<bool> bSyntaxError(false);
+
+	for (unsigned int w = 0; w < nWorkers; w++)
+		workers.push_back(std::thread([&chunks, &bSyntaxError, &total, &mTotal]()
+		{
+			Poker::PokerDealStats counters;
+			Poker::PokerPlayerCards p1, p2;
+			Poker::PokerBoardCards b;
+			std::vector<std::string> lines;
+			try
+			{
+				while (chunks.Pop(lines))
+					for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+					{
+						if (!LoadCards(lines[i], p1, p2, b))
+						{
+							bSyntaxError = true;
+							chunks.Close();
+							return;
+						}
+
+						Poker::PokerBoardPrepared pb(b);
+						counters.Add(pb, Poker::PokerHandHigh(p1, pb), Poker::PokerHandHigh(p2, pb), 
+									 Poker::PokerHandLow(p1, pb), Poker::PokerHandLow(p2, pb));
+					}
+			}
+			catch (const std::length_error&) // more cards than a card set holds
+			{
+				bSyntaxError = true;
+				chunks.Close();
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(mTotal);
+			total += counters;
+		}));
+
+	std::vector<std::string> lines;
+	std::string sCardCombination;
+	while (!ifs.eof() && !bSyntaxError)
+	{
+		std::getline(ifs, sCardCombination);
+		if (!sCardCombination.empty()) lines.push_back(sCardCombination);
+		if (lines.size() == nChunkLines || (ifs.eof() && !lines.empty()))
+		{
+			if (!chunks.Push(std::move(lines))) break;
+			lines.clear();
+		}
+	}
+	chunks.Close();
+	for (unsigned int w = 0; w < nWorkers; w++)
+		workers[w].join();
+
+	if (bSyntaxError)
+	{
+		std::cerr << "Wrong syntax in the input file." << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	Poker::PokerPlayerCards p1, p2;
+	ofs << total;
+	return EXIT_SUCCESS;
+}
+
+bool LoadRanges(const std::string& s, Poker::PokerRange& r1, Poker::PokerRange& r2, Poker::PokerBoardCards& b)
+{
+	std::string s1, s2, sb;
+	if (!SplitCards(s, s1, s2, sb)) return false;
+
+	r1 = Poker::PokerRange(s1);
+	r2 = Poker::PokerRange(s2);
+	b  = Poker::PokerBoardCards(sb);
+	return r1.IsValid() && r2.IsValid() && b.Cards() == 5 && b.IsValid() ? true : false;
+}
+
+int RangeEvaluation(std::istream& ifs, std::ostream& ofs)
+{
+	Poker::PokerRange r1, r2;
 	Poker::PokerBoardCards b;
 	std::string sCardCombination;
 
@@ -67,21 +383,88 @@ int main(int argc, char* argv[])
 		std::getline(ifs, sCardCombination);
 		if (sCardCombination.empty()) continue;
 
-		if (!LoadCards(sCardCombination, p1, p2, b))
+		if (!LoadRanges(sCardCombination, r1, r2, b))
 		{
 			std::cerr << "Wrong syntax in the input file." << std::endl;
 			return EXIT_FAILURE;
 		}
 
-		Poker::PokerHandHigh hi1(p1, b), hi2(p2, b);
+		ofs << sCardCombination << std::endl
+			<< "=> " << (r1.GetName().empty() ? "RangeA" : r1.GetName()) << ": " 
+			<< Poker::EvaluateRangeVsRange(r1, r2, b) << std::endl << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
 
-		ofs << p1 << ' ' << p2 << ' ' << b << std::endl
-			//  << "A: " << hi1 << endl << "B: " << hi2 << endl // for testing
-			<< "=> " << HandEvaluation(hi1, hi2) << "; "
-			<< HandEvaluation(Poker::PokerHandLow(p1, b), Poker::PokerHandLow(p2, b)) << std::endl << std::endl;
+// ---------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "Missing application parameters." << std::endl;
+		return EXIT_FAILURE;
 	}
 
-	ifs.close();
-	ofs.close();
-	return EXIT_SUCCESS;
+	if (!Pipeline::CompressionSupported(Pipeline::CompressionFromFileName(argv[1])) ||
+		!Pipeline::CompressionSupported(Pipeline::CompressionFromFileName(argv[2])))
+	{
+		std::cerr << "This build does not support the requested compression." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Pipeline::InputPipeline in(argv[1]);
+	if (!in.is_open())
+	{
+		std::cerr << "Cannot find the specified input file." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Pipeline::OutputPipeline out(argv[2]);
+	if (!out.is_open())
+	{
+		std::cerr << "Cannot open the specified output file." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::istream ifs(&in);
+	std::ostream ofs(&out);
+	int nResult = EXIT_SUCCESS;
+
+	std::string sMode = argc > 3 ? argv[3] : "";
+	try
+	{
+		if (sMode.empty())
+			nResult = SequentialEvaluation(ifs, ofs);
+		else if (sMode == "-range")
+			nResult = RangeEvaluation(ifs, ofs);
+		else if (sMode == "-batch")
+			nResult = BatchEvaluation(ifs, ofs);
+		else if (sMode == "-outs")
+			nResult = OutsEvaluation(ifs, ofs);
+		else if (sMode == "-stats")
+			nResult = StatsEvaluation(ifs, ofs);
+		else
+		{
+			std::cerr << "Unknown mode: " << sMode << std::endl;
+			nResult = EXIT_FAILURE;
+		}
+	}
+	catch (const std::length_error&) // more cards than a card set holds
+	{
+		std::cerr << "Wrong syntax in the input file." << std::endl;
+		nResult = EXIT_FAILURE;
+	}
+
+	if (!in.close())
+	{
+		std::cerr << in.GetError() << std::endl;
+		nResult = EXIT_FAILURE;
+	}
+	if (!out.close())
+	{
+		std::cerr << out.GetError() << std::endl;
+		nResult = EXIT_FAILURE;
+	}
+	return nResult;
 }
@@ -0,0 +1,361 @@
+#include "PipelineStream.h"
+#include <algorithm>
+
+#ifdef OMAHACOMP_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef OMAHACOMP_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Pipeline
+{
+
+static const std::size_t nBlockSize = 1 << 18;
+static const std::size_t nQueueBlocks = 16;
+
+static bool EndsWith(const std::string& s, const std::string& suffix)
+{
+	return s.length() >= suffix.length() && s.compare(s.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
+
+Compression CompressionFromFileName(const std::string& s)
+{
+	std::string name(s);
+	std::transform(name.begin(), name.end(), name.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+
+	if ( EndsWith(name, ".gz") ) return Compression::compression_gzip;
+	if ( EndsWith(name, ".zst") ) return Compression::compression_zstd;
+	return Compression::compression_none;
+}
+
+bool CompressionSupported(Compression c)
+{
+	switch( c )
+	{
+#ifdef OMAHACOMP_WITH_ZLIB
+		case Compression::compression_gzip: return true;
+#endif
+#ifdef OMAHACOMP_WITH_ZSTD
+		case Compression::compression_zstd: return true;
+#endif
+		case Compression::compression_none: return true;
+		default: return false;
+	}
+}
+
+// ------------------------------------- InputPipeline -----------------------------------------------------
+
+InputPipeline::InputPipeline(const std::string& s) : m_compression(CompressionFromFileName(s)), m_queue(nQueueBlocks)
+{
+	if ( !CompressionSupported(m_compression) )
+		return;
+
+	m_file.open(s, m_compression == Compression::compression_none ? std::ios::in : std::ios::in | std::ios::binary);
+	if ( m_file )
+		m_thread = std::thread(&InputPipeline::Run, this);
+}
+
+bool InputPipeline::close()
+{
+	m_queue.Close();
+	if ( m_thread.joinable() )
+		m_thread.join();
+	m_file.close();
+	return m_error.empty();
+}
+
+std::streambuf::int_type InputPipeline::underflow()
+{
+	if ( gptr() < egptr() )
+		return traits_type::to_int_type(*gptr());
+
+	do
+	{
+		if ( !m_queue.Pop(m_block) )
+			return traits_type::eof();
+	}
+	while ( m_block.empty() );
+
+	setg(&m_block[0], &m_block[0], &m_block[0] + m_block.size());
+	return traits_type::to_int_type(*gptr());
+}
+
+void InputPipeline::Run()
+{
+	switch( m_compression )
+	{
+		case Compression::compression_none: ReadPlain(); break;
+		case Compression::compression_gzip: ReadGzip(); break;
+		case Compression::compression_zstd: ReadZstd(); break;
+	}
+	m_queue.Close();
+}
+
+bool InputPipeline::Deliver(const char* p, std::size_t n) // false once the reader side is closed
+{
+	if ( !n ) return true;
+
+	TextBlock block(p, p + n);
+	if ( m_compression != Compression::compression_none ) // the plain file is opened in text mode
+		block.erase(std::remove(block.begin(), block.end(), '\r'), block.end());
+	return m_queue.Push( std::move(block) );
+}
+
+void InputPipeline::ReadPlain()
+{
+	std::vector<char> in(nBlockSize);
+	while ( m_file.read(&in[0], in.size()) || m_file.gcount() )
+		if ( !Deliver(&in[0], static_cast<std::size_t>(m_file.gcount())) )
+			return;
+	if ( m_file.bad() )
+		m_error = "Cannot read the input file.";
+}
+
+void InputPipeline::ReadGzip()
+{
+#ifdef OMAHACOMP_WITH_ZLIB
+	z_stream z = {};
+	if ( inflateInit2(&z, 15 + 32) != Z_OK ) // gzip or zlib header
+	{
+		m_error = "Cannot initialize gzip decompression.";
+		return;
+	}
+
+	std::vector<char> in(nBlockSize), out(nBlockSize);
+	int ret = Z_OK;
+	bool full = false, stopped = false;
+	for(;;)
+	{
+		if ( !z.avail_in && !full )
+		{
+			m_file.read(&in[0], in.size());
+			z.next_in = reinterpret_cast<Bytef*>(&in[0]);
+			z.avail_in = static_cast<uInt>(m_file.gcount());
+			if ( !z.avail_in ) break;
+		}
+		if ( ret == Z_STREAM_END ) // concatenated gzip members
+			inflateReset(&z);
+
+		z.next_out = reinterpret_cast<Bytef*>(&out[0]);
+		z.avail_out = static_cast<uInt>(out.size());
+		ret = inflate(&z, Z_NO_FLUSH);
+		if ( ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR )
+		{
+			m_error = "Corrupted gzip input.";
+			break;
+		}
+		full = !z.avail_out && ret != Z_STREAM_END;
+		if ( !Deliver(&out[0], out.size() - z.avail_out) )
+		{
+			stopped = true;
+			break;
+		}
+	}
+	if ( m_error.empty() && !stopped && ret != Z_STREAM_END )
+		m_error = "Truncated gzip input.";
+	inflateEnd(&z);
+#endif
+}
+
+void InputPipeline::ReadZstd()
+{
+#ifdef OMAHACOMP_WITH_ZSTD
+	ZSTD_DCtx* d = ZSTD_createDCtx();
+	if ( !d )
+	{
+		m_error = "Cannot initialize zstd decompression.";
+		return;
+	}
+
+	std::vector<char> in(ZSTD_DStreamInSize()), out(ZSTD_DStreamOutSize());
+	ZSTD_inBuffer input = { &in[0], 0, 0 };
+	std::size_t ret = 0;
+	bool full = false, stopped = false;
+	for(;;)
+	{
+		if ( input.pos == input.size && !full )
+		{
+			m_file.read(&in[0], in.size());
+			input.size = static_cast<std::size_t>(m_file.gcount());
+			input.pos = 0;
+			if ( !input.size ) break;
+		}
+
+		ZSTD_outBuffer output = { &out[0], out.size(), 0 };
+		ret = ZSTD_decompressStream(d, &output, &input);
+		if ( ZSTD_isError(ret) )
+		{
+			m_error = std::string("Corrupted zstd input: ") + ZSTD_getErrorName(ret);
+			break;
+		}
+		full = output.pos == output.size;
+		if ( !Deliver(&out[0], output.pos) )
+		{
+			stopped = true;
+			break;
+		}
+	}
+	if ( m_error.empty() && !stopped && ret != 0 )
+		m_error = "Truncated zstd input.";
+	ZSTD_freeDCtx(d);
+#endif
+}
+
+// ------------------------------------- OutputPipeline ----------------------------------------------------
+
+OutputPipeline::OutputPipeline(const std::string& s) : m_compression(CompressionFromFileName(s)), m_queue(nQueueBlocks)
+{
+	if ( !CompressionSupported(m_compression) )
+		return;
+
+	m_file.open(s, m_compression == Compression::compression_none ? std::ios::out : std::ios::out | std::ios::binary);
+	if ( m_file )
+	{
+		NewBlock();
+		m_thread = std::thread(&OutputPipeline::Run, this);
+	}
+}
+
+bool OutputPipeline::close()
+{
+	if ( m_thread.joinable() )
+	{
+		m_block.resize(pptr() - pbase());
+		m_queue.Push( std::move(m_block) );
+		setp(nullptr, nullptr);
+		m_queue.Close();
+		m_thread.join();
+
+		m_file.close();
+		if ( m_file.fail() && m_error.empty() )
+			m_error = "Cannot write the output file.";
+	}
+	return m_error.empty();
+}
+
+void OutputPipeline::NewBlock()
+{
+	m_block.resize(nBlockSize);
+	setp(&m_block[0], &m_block[0] + m_block.size());
+}
+
+// std::endl only flushes into the current block; full blocks are handed to the writer thread here.
+std::streambuf::int_type OutputPipeline::overflow(int_type c)
+{
+	if ( !m_thread.joinable() )
+		return traits_type::eof();
+
+	m_block.resize(pptr() - pbase());
+	if ( !m_queue.Push( std::move(m_block) ) )
+		return traits_type::eof();
+
+	NewBlock();
+	if ( !traits_type::eq_int_type(c, traits_type::eof()) )
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+void OutputPipeline::Run()
+{
+	switch( m_compression )
+	{
+		case Compression::compression_none: WritePlain(); break;
+		case Compression::compression_gzip: WriteGzip(); break;
+		case Compression::compression_zstd: WriteZstd(); break;
+	}
+
+	TextBlock block; // on a codec error keep draining so that the producer never blocks
+	while ( m_queue.Pop(block) ) { }
+}
+
+bool OutputPipeline::Write(const char* p, std::size_t n)
+{
+	if ( n && m_error.empty() && !m_file.write(p, n) )
+		m_error = "Cannot write the output file.";
+	return m_error.empty();
+}
+
+void OutputPipeline::WritePlain()
+{
+	TextBlock block;
+	while ( m_queue.Pop(block) )
+		Write(block.data(), block.size());
+}
+
+void OutputPipeline::WriteGzip()
+{
+#ifdef OMAHACOMP_WITH_ZLIB
+	z_stream z = {};
+	if ( deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK ) // gzip header
+	{
+		m_error = "Cannot initialize gzip compression.";
+		return;
+	}
+
+	std::vector<char> out(nBlockSize);
+	TextBlock block;
+	int flush = Z_NO_FLUSH;
+	do
+	{
+		flush = m_queue.Pop(block) ? Z_NO_FLUSH : Z_FINISH;
+		if ( flush == Z_FINISH ) block.clear();
+		z.next_in = reinterpret_cast<Bytef*>(block.data());
+		z.avail_in = static_cast<uInt>(block.size());
+		do
+		{
+			z.next_out = reinterpret_cast<Bytef*>(&out[0]);
+			z.avail_out = static_cast<uInt>(out.size());
+			deflate(&z, flush);
+			Write(&out[0], out.size() - z.avail_out);
+		}
+		while ( !z.avail_out );
+	}
+	while ( flush != Z_FINISH && m_error.empty() );
+	deflateEnd(&z);
+#endif
+}
+
+void OutputPipeline::WriteZstd()
+{
+#ifdef OMAHACOMP_WITH_ZSTD
+	ZSTD_CCtx* c = ZSTD_createCCtx();
+	if ( !c )
+	{
+		m_error = "Cannot initialize zstd compression.";
+		return;
+	}
+
+	std::vector<char> out(ZSTD_CStreamOutSize());
+	TextBlock block;
+	bool more = true;
+	do
+	{
+		more = m_queue.Pop(block);
+		if ( !more ) block.clear();
+		ZSTD_EndDirective mode = more ? ZSTD_e_continue : ZSTD_e_end;
+		ZSTD_inBuffer input = { block.data(), block.size(), 0 };
+		std::size_t ret = 0;
+		do
+		{
+			ZSTD_outBuffer output = { &out[0], out.size(), 0 };
+			ret = ZSTD_compressStream2(c, &output, &input, mode);
+			if ( ZSTD_isError(ret) )
+			{
+				m_error = std::string("Cannot compress the output: ") + ZSTD_getErrorName(ret);
+				break;
+			}
+			Write(&out[0], output.pos);
+		}
+		while ( more ? input.pos < input.size : ret != 0 );
+	}
+	while ( more && m_error.empty() );
+	ZSTD_freeCCtx(c);
+#endif
+}
+
+} // End Namespace Pipeline
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*	Input and output files are read and written by dedicated threads connected to the evaluation
+	by bounded queues of text blocks, so decompression/compression and disk I/O overlap the
+	CPU-bound work. Files ending in ".gz" or ".zst" are (de)compressed on those threads; the codecs
+	are compiled in with OMAHACOMP_WITH_ZLIB (link zlib) and OMAHACOMP_WITH_ZSTD (link libzstd).
+*/
+
+namespace Pipeline
+{
+	enum class Compression { compression_none, compression_gzip, compression_zstd };
+
+	Compression CompressionFromFileName(const std::string&);
+	bool CompressionSupported(Compression);
+
+	// -------------------------------------------------------------------------------------------------------
+
+	template <class T>
+	class BoundedQueue
+	{
+	protected:
+
+		std::deque<T> m_items;
+		std::size_t m_capacity;
+		bool m_closed;
+		std::mutex m_mutex;
+		std::condition_variable m_not_empty, m_not_full;
+
+	public:
+
+		BoundedQueue(std::size_t capacity) : m_capacity(capacity), m_closed(false) { }
+
+		bool Push(T item) // false once the queue is closed
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+			if ( m_closed ) return false;
+			m_items.push_back( std::move(item) );
+			m_not_empty.notify_one();
+			return true;
+		}
+
+		bool Pop(T& item) // false once the queue is closed and drained
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+			if ( m_items.empty() ) return false;
+			item = std::move( m_items.front() );
+			m_items.pop_front();
+			m_not_full.notify_one();
+			return true;
+		}
+
+		void Close()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closed = true;
+			m_not_empty.notify_all();
+			m_not_full.notify_all();
+		}
+	};
+
+	using TextBlock = std::vector<char>;
+
+	// -------------------------------------------------------------------------------------------------------
+
+	class InputPipeline : public std::streambuf
+	{
+	protected:
+
+		std::ifstream m_file;
+		Compression m_compression;
+		BoundedQueue<TextBlock> m_queue;
+		TextBlock m_block;
+		std::thread m_thread;
+		std::string m_error;
+
+		void Run();
+		void ReadPlain();
+		void ReadGzip();
+		void ReadZstd();
+		bool Deliver(const char*, std::size_t);
+
+		virtual int_type underflow();
+
+	public:
+
+		InputPipeline(const std::string&);
+		~InputPipeline() { close(); }
+
+		bool is_open() const { return m_thread.joinable(); }
+		bool close(); // false on a read or decompression error, see GetError()
+		std::string GetError() const { return m_error; }
+	};
+
+	// -------------------------------------------------------------------------------------------------------
+
+	class OutputPipeline : public std::streambuf
+	{
+	protected:
+
+		std::ofstream m_file;
+		Compression m_compression;
+		BoundedQueue<TextBlock> m_queue;
+		TextBlock m_block;
+		std::thread m_thread;
+		std::string m_error;
+
+		void Run();
+		void WritePlain();
+		void WriteGzip();
+		void WriteZstd();
+		void NewBlock();
+		bool Write(const char*, std::size_t);
+
+		virtual int_type overflow(int_type);
+
+	public:
+
+		OutputPipeline(const std::string&);
+		~OutputPipeline() { close(); }
+
+		bool is_open() const { return m_thread.joinable(); }
+		bool close(); // false on a write or compression error, see GetError()
+		std::string GetError() const { return m_error; }
+	};
+
+} // End Namespace Pipeline
@@ -37,6 +37,23 @@ PlayingCard::PlayingCard(const std::string& r)
 		}
 }
 
+char PlayingCard::GetRankChar() const
+{
+	if ( m_rank >=2 && m_rank <=9 )
+		return static_cast<char>('0' + m_rank);
+
+	switch( m_rank )
+	{
+		case 10: return 'T';
+		case 11: return 'J';
+		case 12: return 'Q';
+		case 13: return 'K';
+		case 1: 
+		case 14: return 'A';
+		default: return '#';
+	}
+}
+
 std::string PlayingCard::ToString() const
 {
 	std::ostringstream oss;
@@ -44,18 +61,7 @@ std::string PlayingCard::ToString() const
 		oss << "##";
 	else
 	{
-		if ( m_rank >=2 && m_rank <=9 )
-			oss << m_rank;
-		else
-			switch( m_rank )
-			{
-				case 10: oss << 'T'; break;
-				case 11: oss << 'J'; break;
-				case 12: oss << 'Q'; break;
-				case 13: oss << 'K'; break;
-				case 1: 
-				case 14: oss << 'A'; break;
-			}
+		oss << GetRankChar();
 
 		switch( m_suit ) 
 		{
@@ -99,6 +105,29 @@ std::string PokerCardSet::ToString() const
 	return oss.str();
 }
 
+bool PokerCardSet::IsValid() const
+{
+	unsigned long long mask = 0;
+	for(PokerCardArray::size_type i = 0; i < Cards(); i++)
+	{
+		int n = m_cards[i].GetCardIndex();
+		if ( n < 0 || mask & (1ULL << n) ) return false;
+		mask |= 1ULL << n;
+	}
+	return true;
+}
+
+bool PokerCardSet::MakeWheel() // A-5-4-3-2 of a sorted set, the ace is moved to the end as the lowest card
+{
+	if ( m_cards[0].GetCardRank() != 14 || m_cards[1].GetCardRank() != 5 || m_cards[2].GetCardRank() != 4 ||
+		 m_cards[3].GetCardRank() != 3 || m_cards[4].GetCardRank() != 2 )
+		return false;
+
+	m_cards[0].AceToLowestCard();
+	MoveFirstCardToTheEnd();
+	return true;
+}
+
 bool PokerCardSet::MakeStraightFlush() // rank: 9
 {
 	if ( Cards() != 5 || !AllCardsOfTheSameSuit() ) 
@@ -108,16 +137,7 @@ bool PokerCardSet::MakeStraightFlush() // rank: 9
 	if ( InConsecutiveOrder() ) 
 		return true;
 
-	if ( m_cards[0].GetCardRank() == 14 )
-	{
-		PokerCardArray old(m_cards);
-		m_cards[0].AceToLowestCard();
-		MoveFirstCardToTheEnd();
-		if ( InConsecutiveOrder() )
-			return true;
-		m_cards = old;
-	}
-	return false;
+	return MakeWheel();
 }
 
 bool PokerCardSet::Make4ofKind() // rank: 8
@@ -176,16 +196,7 @@ bool PokerCardSet::MakeStraight() // rank: 5
 	if ( InConsecutiveOrder() ) 
 		return true;
 
-	if ( m_cards[0].GetCardRank() == 14 )
-	{
-		PokerCardArray old(m_cards);
-		m_cards[0].AceToLowestCard();
-		MoveFirstCardToTheEnd();
-		if ( InConsecutiveOrder() )
-			return true;
-		m_cards = old;
-	}
-	return false;
+	return MakeWheel();
 }
 
 bool PokerCardSet::Make3ofKind() // rank: 4
@@ -194,7 +205,7 @@ bool PokerCardSet::Make3ofKind() // rank: 4
 		return false;
 	
 	SortSet();
-	PokerCardArray::iterator it = adjacent_find( m_cards.begin(), m_cards.end() );
+	PokerCardArray::iterator it = std::adjacent_find( m_cards.begin(), m_cards.end() );
     if ( it == m_cards.end() ) 
 		return false;
 
@@ -205,7 +216,7 @@ bool PokerCardSet::Make3ofKind() // rank: 4
 	    m_cards[0].GetCardRank() == m_cards[2].GetCardRank() &&
 	    m_cards[3].GetCardRank() != m_cards[4].GetCardRank() )
 	{
-		sort(m_cards.begin()+3, m_cards.end(), std::greater<PokerCard>());
+		std::sort(m_cards.begin()+3, m_cards.end(), std::greater<PokerCard>());
 		return true;
 	}
 	return false;
@@ -216,7 +227,7 @@ bool PokerCardSet::MakeTwoPair()  // rank: 3
 	if ( Cards() != 5 ) return false;
 	SortSet();
 
-	PokerCardArray::iterator it = adjacent_find( m_cards.begin(), m_cards.end() );
+	PokerCardArray::iterator it = std::adjacent_find( m_cards.begin(), m_cards.end() );
     if ( it == m_cards.end() ) 
 		return false;
 
@@ -243,7 +254,7 @@ bool PokerCardSet::MakeOnePair() // rank: 2
 	if ( Cards() != 5 ) return false;
 	SortSet();
 
-	PokerCardArray::iterator it = adjacent_find( m_cards.begin(), m_cards.end() );
+	PokerCardArray::iterator it = std::adjacent_find( m_cards.begin(), m_cards.end() );
     if ( it == m_cards.end() ) 
 		return false;
 
@@ -251,18 +262,82 @@ bool PokerCardSet::MakeOnePair() // rank: 2
 		MoveFirstCardToTheEnd();
 
 	PokerCardArray t(m_cards);
-	if ( distance( t.begin(), unique(t.begin(), t.end()) ) == 4 )
+	if ( std::distance( t.begin(), std::unique(t.begin(), t.end()) ) == 4 )
 	{
-		sort(m_cards.begin()+2, m_cards.end(), std::greater<PokerCard>());
+		std::sort(m_cards.begin()+2, m_cards.end(), std::greater<PokerCard>());
 		return true;
 	}
 	return false;
 }
 
+// ------------------------------------- PokerBoardPrepared --------------------------------------------
+
+PokerBoardPrepared::PokerBoardPrepared(const PokerBoardCards& b) : m_board(b.GetCards()), m_low(b.GetCards()), m_new_high(0), m_new_low(0)
+{
+	if ( b.Cards() > max_cards )
+		throw std::length_error("PokerBoardPrepared: boards of more than 5 cards are not supported");
+
+	MakeTriples(b, m_high_triples);
+
+	m_low.MakeLow8();
+	MakeTriples(m_low, m_low_triples);
+}
+
+PokerBoardPrepared::PokerBoardPrepared(const PokerBoardPrepared& partial, const PokerCard& c) : 
+	m_board(partial.m_board), m_low(partial.m_low), 
+	m_high_triples(partial.m_high_triples), m_low_triples(partial.m_low_triples),
+	m_new_high(partial.m_high_triples.size()), m_new_low(partial.m_low_triples.size())
+{
+	if ( m_board.Cards() >= max_cards )
+		throw std::length_error("PokerBoardPrepared: boards of more than 5 cards are not supported");
+
+	PokerCardTriple t;
+	PokerCardArray::size_type pb1, pb2;
+
+	t[2] = c;
+	t[2].SetAsFromBoard();
+	for(pb1 = 0; pb1 < m_board.Cards(); pb1++)
+		for(t[0] = m_board[pb1], pb2 = pb1 + 1; pb2 < m_board.Cards(); pb2++)
+		{
+			t[1] = m_board[pb2];
+			m_high_triples.push_back(t);
+		}
+	m_board.AddCard(t[2]);
+
+	// A low card whose rank is already on the board adds nothing for Low (MakeLow8 dedups ranks)
+	t[2].transformForLow8();
+	if ( t[2].IsLow8() && std::find(m_low.GetCards().begin(), m_low.GetCards().end(), t[2]) == m_low.GetCards().end() )
+	{
+		for(pb1 = 0; pb1 < m_low.Cards(); pb1++)
+			for(t[0] = m_low[pb1], pb2 = pb1 + 1; pb2 < m_low.Cards(); pb2++)
+			{
+				t[1] = m_low[pb2];
+				m_low_triples.push_back(t);
+			}
+		m_low.AddCard(t[2]);
+		m_low.MakeLow8();
+	}
+}
+
+void PokerBoardPrepared::MakeTriples(const PokerCardSet& b, PokerCardTripleArray& triples)
+{
+	triples.clear();
+	PokerCardTriple t;
+	PokerCardArray::size_type pb1, pb2, pb3;
+	for(pb1 = 0; pb1 < b.Cards(); pb1++)
+		for(t[0] = b[pb1], pb2 = pb1 + 1; pb2 < b.Cards(); pb2++)
+			for(t[1] = b[pb2], pb3 = pb2 + 1; pb3 < b.Cards(); pb3++)
+			{
+				t[2] = b[pb3];
+				triples.push_back(t);
+			}
+}
+
 // ------------------------------------- PokerHandLow --------------------------------------------------
 
-PokerHandLow::PokerHandLow(PokerPlayerCards a, PokerBoardCards b)
+PokerHandLow::PokerHandLow(const PokerPlayerCards& player, const PokerBoardCards& board)
 {
+	PokerCardSet a(player.GetCards()), b(board.GetCards()); // cards only, the set names are not needed
 	a.MakeLow8();
 	b.MakeLow8();
 	if ( a.Cards() >= 2 && b.Cards() >= 3 )
@@ -276,30 +351,72 @@ PokerHandLow::PokerHandLow(PokerPlayerCards a, PokerBoardCards b)
 						for(ar[3] = b[pb2], pb3 = pb2 + 1; pb3 < b.Cards(); pb3++)
 						{
 							ar[4] = b[pb3];
-
-							PokerCardArray candidate(ar);
-							sort(candidate.begin(), candidate.end());
-							if ( distance( candidate.begin(), unique(candidate.begin(), candidate.end()) ) == 5 )
-							{
-								reverse( candidate.begin(), candidate.end() );
-								if ( !Cards() || candidate < m_cards ) m_cards = candidate;
-							}
+							Consider(ar);
 						}
 	}
+	Qualify();
+}
+
+PokerHandLow::PokerHandLow(const PokerPlayerCards& a, const PokerBoardPrepared& b)
+{
+	Evaluate(a, b, 0);
+}
+
+PokerHandLow::PokerHandLow(const PokerHandLow& partial, const PokerPlayerCards& a, const PokerBoardPrepared& b) : PokerHandLow(partial)
+{
+	Evaluate(a, b, b.GetNewLowTriples());
+}
+
+void PokerHandLow::Evaluate(const PokerPlayerCards& player, const PokerBoardPrepared& b, PokerCardTripleArray::size_type first)
+{
+	PokerCardSet a(player.GetCards()); // cards only, the set name is not needed
+	a.MakeLow8();
+	const PokerCardTripleArray& triples = b.GetLowTriples();
+	if ( a.Cards() >= 2 && first < triples.size() )
+	{
+		PokerCardArray ar(5);
+		PokerCardArray::size_type p1, p2, t;
+		for(p1 = 0; p1 < a.Cards(); p1++)
+			for(ar[0] = a[p1], p2 = p1 + 1; p2 < a.Cards(); p2++)
+				for(ar[1] = a[p2], t = first; t < triples.size(); t++)
+				{
+					ar[2] = triples[t][0];
+					ar[3] = triples[t][1];
+					ar[4] = triples[t][2];
+					Consider(ar);
+				}
+	}
+	Qualify();
+}
+
+void PokerHandLow::Consider(PokerCardArray candidate)
+{
+	std::sort(candidate.begin(), candidate.end());
+	if ( std::distance( candidate.begin(), std::unique(candidate.begin(), candidate.end()) ) == 5 )
+	{
+		std::reverse( candidate.begin(), candidate.end() );
+		if ( !Cards() || candidate < m_cards ) m_cards = candidate;
+	}
+}
+
+void PokerHandLow::Qualify()
+{
 	m_qualified = Cards() == 5;
-	if ( m_qualified ) 
-		m_rank_name = ToString();
+	if ( m_qualified ) // same as ToString() for suitless cards, without a stream
+	{
+		m_rank_name.clear();
+		for(PokerCardArray::size_type i = 0; i < Cards(); i++)
+			m_rank_name += m_cards[i].GetRankChar();
+	}
 }
 
 // ------------------------------------- PokerHandHigh ------------------------------------------------
 
-PokerHandHigh::PokerHandHigh(PokerPlayerCards a, PokerBoardCards b)
+PokerHandHigh::PokerHandHigh(const PokerPlayerCards& a, const PokerBoardCards& b) : m_hand_rank(0)
 {
-	m_hand_rank = 0;
 	if ( a.Cards() >= 2 && b.Cards() >= 3 )
 	{
 		PokerCardArray ar(5);
-		unsigned int ar_rank = 0;
 		PokerCardArray::size_type p1, p2, pb1, pb2, pb3;
 		for(p1 = 0; p1 < a.Cards(); p1++)
 			for(ar[0] = a[p1], p2 = p1 + 1; p2 < a.Cards(); p2++)
@@ -308,35 +425,71 @@ PokerHandHigh::PokerHandHigh(PokerPlayerCards a, PokerBoardCards b)
 						for(ar[3] = b[pb2], pb3 = pb2 + 1; pb3 < b.Cards(); pb3++)
 						{
 							ar[4] = b[pb3];
-
-							PokerCardSet candidate(ar);
-
-							if ( candidate.MakeStraightFlush() ) ar_rank = 9;
-							else if ( m_hand_rank <= 8 && candidate.Make4ofKind() )   ar_rank = 8;	
-							else if ( m_hand_rank <= 7 && candidate.MakeFullHouse() ) ar_rank = 7;	
-							else if ( m_hand_rank <= 6 && candidate.MakeFlush() )     ar_rank = 6;	
-							else if ( m_hand_rank <= 5 && candidate.MakeStraight() )  ar_rank = 5;	
-							else if ( m_hand_rank <= 4 && candidate.Make3ofKind() )   ar_rank = 4;	
-							else if ( m_hand_rank <= 3 && candidate.MakeTwoPair() )   ar_rank = 3;	
-							else if ( m_hand_rank <= 2 && candidate.MakeOnePair() )   ar_rank = 2;	
-							else 
-							{
-								candidate.SortSet();
-								ar_rank = 1;	
-							}
-
-							if ( !Cards() || ar_rank > m_hand_rank || 
-								 ar_rank == m_hand_rank && candidate > m_cards ) 
-							{ 
-								m_cards = candidate.GetCards(); 
-								m_hand_rank = ar_rank;
-							}
+							Consider(ar);
 						}
 
 		m_rank_name = GetRankNameForHighHand(m_hand_rank);
 	}
 }
 
+PokerHandHigh::PokerHandHigh(const PokerPlayerCards& a, const PokerBoardPrepared& b) : m_hand_rank(0)
+{
+	Evaluate(a, b, 0);
+}
+
+PokerHandHigh::PokerHandHigh(const PokerHandHigh& partial, const PokerPlayerCards& a, const PokerBoardPrepared& b) : PokerHandHigh(partial)
+{
+	Evaluate(a, b, b.GetNewHighTriples());
+}
+
+void PokerHandHigh::Evaluate(const PokerPlayerCards& a, const PokerBoardPrepared& b, PokerCardTripleArray::size_type first)
+{
+	const PokerCardTripleArray& triples = b.GetHighTriples();
+	if ( a.Cards() >= 2 && first < triples.size() )
+	{
+		PokerCardArray ar(5);
+		PokerCardArray::size_type p1, p2, t;
+		for(p1 = 0; p1 < a.Cards(); p1++)
+			for(ar[0] = a[p1], p2 = p1 + 1; p2 < a.Cards(); p2++)
+				for(ar[1] = a[p2], t = first; t < triples.size(); t++)
+				{
+					ar[2] = triples[t][0];
+					ar[3] = triples[t][1];
+					ar[4] = triples[t][2];
+					Consider(ar);
+				}
+
+		m_rank_name = GetRankNameForHighHand(m_hand_rank);
+	}
+}
+
+void PokerHandHigh::Consider(const PokerCardArray& ar)
+{
+	PokerCardSet candidate(ar);
+	unsigned int ar_rank = 0;
+
+	if ( candidate.MakeStraightFlush() ) ar_rank = 9;
+	else if ( m_hand_rank <= 8 && candidate.Make4ofKind() )   ar_rank = 8;	
+	else if ( m_hand_rank <= 7 && candidate.MakeFullHouse() ) ar_rank = 7;	
+	else if ( m_hand_rank <= 6 && candidate.MakeFlush() )     ar_rank = 6;	
+	else if ( m_hand_rank <= 5 && candidate.MakeStraight() )  ar_rank = 5;	
+	else if ( m_hand_rank <= 4 && candidate.Make3ofKind() )   ar_rank = 4;	
+	else if ( m_hand_rank <= 3 && candidate.MakeTwoPair() )   ar_rank = 3;	
+	else if ( m_hand_rank <= 2 && candidate.MakeOnePair() )   ar_rank = 2;	
+	else 
+	{
+		candidate.SortSet();
+		ar_rank = 1;	
+	}
+
+	if ( !Cards() || ar_rank > m_hand_rank || 
+		 ar_rank == m_hand_rank && candidate > m_cards ) 
+	{ 
+		m_cards = candidate.GetCards(); 
+		m_hand_rank = ar_rank;
+	}
+}
+
 std::string PokerHandHigh::ToString() const // for testing
 {
 	std::ostringstream oss;
@@ -374,4 +527,13 @@ std::string PokerHandHigh::GetRankNameForHighHand(unsigned int n)
 	}
 }
 
+// ------------------------------------- HandComparison --------------------------------------------------
+
+int HandComparison(const PokerHand& h1, const PokerHand& h2)
+{
+	if ( (!h1.qualified() && !h2.qualified()) || h1 == h2 )
+		return 0;
+	return h1 > h2 ? 1 : -1;
+}
+
 } // End Namespace Poker
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <sstream>
+#include <stdexcept>
 
 namespace Poker
 {
@@ -33,9 +35,15 @@ namespace Poker
 		virtual bool operator == (const PlayingCard& rValue) const { return m_rank == rValue.m_rank && m_suit == rValue.m_suit; }
 		virtual bool operator != (const PlayingCard& rValue) const { return m_rank != rValue.m_rank || m_suit != rValue.m_suit; }
 		virtual std::string ToString() const;
+		char GetRankChar() const;
 
 		unsigned int GetCardRank() const { return m_rank; }
 		Suit GetSuit() const { return m_suit; }
+		int GetCardIndex() const // 0..51 for a fully specified card, -1 otherwise
+		{ 
+			return m_rank >= 2 && m_rank <= 14 && m_suit != Suit::suit_unknown ? 
+				   (m_rank - 2) * 4 + static_cast<int>(m_suit) - 1 : -1; 
+		}
 		bool empty() const { return m_rank ? false : true; }
 	};
 
@@ -80,7 +88,88 @@ namespace Poker
 		virtual bool operator <= (const PokerCard& rValue) const { return m_rank <= rValue.m_rank; }
 	};
 
-	using PokerCardArray = std::vector<PokerCard>;
+	/* -------------------------------------------------------------------------------------------------------
+		Fixed-capacity inline storage with the part of the std::vector interface used by the card sets,
+		so that evaluating a deal does not touch the heap. Growing past the capacity N throws std::length_error.
+	*/
+
+	template <class T, std::size_t N>
+	class PokerFixedArray
+	{
+	protected:
+
+		std::array<T, N> m_items;
+		std::size_t m_size;
+
+	public:
+
+		using value_type = T;
+		using size_type = std::size_t;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		PokerFixedArray() : m_size(0) { }
+		explicit PokerFixedArray(size_type n) : m_size(0) { resize(n); }
+		PokerFixedArray(const PokerFixedArray& other) : m_size(other.m_size) { std::copy(other.begin(), other.end(), begin()); }
+
+		PokerFixedArray& operator= (const PokerFixedArray& rValue)
+		{
+			m_size = rValue.m_size; std::copy(rValue.begin(), rValue.end(), begin());
+			return *this;
+		}
+
+		iterator begin() { return m_items.data(); }
+		iterator end() { return m_items.data() + m_size; }
+		const_iterator begin() const { return m_items.data(); }
+		const_iterator end() const { return m_items.data() + m_size; }
+
+		size_type size() const { return m_size; }
+		bool empty() const { return !m_size; }
+		static size_type capacity() { return N; }
+
+		T& operator [] (size_type i) { return m_items[i]; }
+		const T& operator [] (size_type i) const { return m_items[i]; }
+
+		void clear() { m_size = 0; }
+		void push_back(const T& v)
+		{
+			if ( m_size == N ) throw std::length_error("PokerFixedArray: capacity exceeded");
+			m_items[m_size++] = v;
+		}
+
+		void resize(size_type n)
+		{
+			if ( n > N ) throw std::length_error("PokerFixedArray: capacity exceeded");
+			for(; m_size < n; m_size++) m_items[m_size] = T();
+			m_size = n;
+		}
+
+		iterator insert(iterator pos, const_iterator first, const_iterator last)
+		{
+			PokerFixedArray t; // the source may be this array
+			for(; first != last; ++first) t.push_back(*first);
+
+			size_type at = pos - begin(), n = t.size();
+			if ( n > N - m_size ) throw std::length_error("PokerFixedArray: capacity exceeded");
+			std::copy_backward(begin() + at, end(), end() + n);
+			std::copy(t.begin(), t.begin() + n, begin() + at);
+			m_size += n;
+			return begin() + at;
+		}
+	};
+
+	template <class T, std::size_t N>
+	bool operator == (const PokerFixedArray<T, N>& x, const PokerFixedArray<T, N>& y) 
+	{ return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin()); }
+
+	template <class T, std::size_t N>
+	bool operator < (const PokerFixedArray<T, N>& x, const PokerFixedArray<T, N>& y) 
+	{ return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end()); }
+
+	template <class T, std::size_t N>
+	bool operator > (const PokerFixedArray<T, N>& x, const PokerFixedArray<T, N>& y) { return y < x; }
+
+	using PokerCardArray = PokerFixedArray<PokerCard, 10>; // a hand plus a board; longer card strings throw
 
 	// -------------------------------------------------------------------------------------------------------
 
@@ -93,7 +182,8 @@ namespace Poker
 
 	private:
 
-		static bool notQualifyForLow8(PokerCard c) { return !c.IsLow8(); }
+		static bool notQualifyForLow8(const PokerCard& c) { return !c.IsLow8(); }
+		bool MakeWheel();
 
 	public:
 
@@ -106,6 +196,7 @@ namespace Poker
 
 		virtual std::string ToString() const;
 		unsigned int Cards() const { return m_cards.size(); }
+		bool IsValid() const; // every card has a rank and a suit and none is repeated
 
 		std::string GetName() const { return m_set_name; }
 		void SetName(std::string& s) { m_set_name = s; }
@@ -119,6 +210,8 @@ namespace Poker
 			return *this; 
 		}
 
+		void AddCard(const PokerCard& c) { m_cards.push_back(c); }
+
 		PokerCardSet& operator + (const PokerCardSet& rValue) 
 		{ 
 			m_cards.insert(m_cards.end(), rValue.m_cards.begin(), rValue.m_cards.end()); 
@@ -129,7 +222,7 @@ namespace Poker
 		bool operator > (const PokerCardSet& rValue) const  { return Cards() == rValue.Cards() && m_cards > rValue.m_cards; }
 		bool operator < (const PokerCardSet& rValue) const  { return Cards() == rValue.Cards() && m_cards < rValue.m_cards; }
 
-		void SortSet() { sort(m_cards.begin(), m_cards.end(), std::greater<PokerCard>()); }
+		void SortSet() { std::sort(m_cards.begin(), m_cards.end(), std::greater<PokerCard>()); }
 
 		bool InConsecutiveOrder() const
 		{
@@ -156,9 +249,9 @@ namespace Poker
 			for(PokerCardArray::iterator pos = m_cards.begin(); pos != m_cards.end(); ++pos) 
 				pos->transformForLow8();
 
-			PokerCardArray::iterator it = remove_if(m_cards.begin(), m_cards.end(), PokerCardSet::notQualifyForLow8);
-			sort(m_cards.begin(), it);
-			m_cards.resize( distance(m_cards.begin(), unique(m_cards.begin(), it) ) );
+			PokerCardArray::iterator it = std::remove_if(m_cards.begin(), m_cards.end(), PokerCardSet::notQualifyForLow8);
+			std::sort(m_cards.begin(), it);
+			m_cards.resize( std::distance(m_cards.begin(), std::unique(m_cards.begin(), it) ) );
 		}	
 
 		void MoveFirstCardToTheEnd()
@@ -200,6 +293,7 @@ namespace Poker
 	public:
 
 		PokerBoardCards() { }
+		explicit PokerBoardCards(const PokerCardArray& ar) : PokerCardSet(ar) { }
 		PokerBoardCards(const std::string& s) : PokerCardSet(s)
 		{ 
 			for(PokerCardArray::iterator pos = m_cards.begin(); pos != m_cards.end(); ++pos) 
@@ -207,6 +301,49 @@ namespace Poker
 		}
 	};
 
+	/* -------------------------------------------------------------------------------------------------------
+		Board digested once for any number of hands: the 3-card board combinations for High and,
+		after MakeLow8, for Low. Hands sharing a board should share one PokerBoardPrepared.
+		A prepared board can be extended by one card (flop -> turn -> river); the combinations that
+		include the new card are appended, starting at GetNewHighTriples()/GetNewLowTriples().
+		Only the cards are kept (GetBoard() has no set name), so preparing a board and evaluating
+		hands against it never allocates, see Tests/AllocationTest.cpp.
+		Boards of more than 5 cards throw std::length_error; evaluate those with the PokerBoardCards
+		constructors of PokerHandHigh/PokerHandLow.
+	*/
+
+	using PokerCardTriple = std::array<PokerCard, 3>;
+	using PokerCardTripleArray = PokerFixedArray<PokerCardTriple, 10>; // C(5,3)
+
+	class PokerBoardPrepared
+	{
+	protected:
+
+		PokerBoardCards m_board;
+		PokerCardSet m_low;
+		PokerCardTripleArray m_high_triples;
+		PokerCardTripleArray m_low_triples;
+		PokerCardTripleArray::size_type m_new_high;
+		PokerCardTripleArray::size_type m_new_low;
+
+		static void MakeTriples(const PokerCardSet&, PokerCardTripleArray&);
+
+	public:
+
+		static const unsigned int max_cards = 5;
+
+		PokerBoardPrepared(const PokerBoardCards&);
+		PokerBoardPrepared(const PokerBoardPrepared&, const PokerCard&);
+
+		const PokerBoardCards& GetBoard() const { return m_board; }
+		const PokerCardTripleArray& GetHighTriples() const { return m_high_triples; }
+		const PokerCardTripleArray& GetLowTriples() const { return m_low_triples; }
+		PokerCardTripleArray::size_type GetNewHighTriples() const { return m_new_high; }
+		PokerCardTripleArray::size_type GetNewLowTriples() const { return m_new_low; }
+	};
+
+	inline std::ostream& operator<<(std::ostream& out, const PokerBoardPrepared& b) { return out << b.GetBoard(); }
+
 	// -------------------------------------------------------------------------------------------------------
 
 	class PokerHand : public PokerCardSet  // Abstract Class
@@ -249,9 +386,14 @@ namespace Poker
 
 		unsigned int m_hand_rank;
 
+		void Consider(const PokerCardArray&);
+		void Evaluate(const PokerPlayerCards&, const PokerBoardPrepared&, PokerCardTripleArray::size_type);
+
 	public:
 
-		PokerHandHigh(PokerPlayerCards, PokerBoardCards);
+		PokerHandHigh(const PokerPlayerCards&, const PokerBoardCards&);
+		PokerHandHigh(const PokerPlayerCards&, const PokerBoardPrepared&);
+		PokerHandHigh(const PokerHandHigh&, const PokerPlayerCards&, const PokerBoardPrepared&); // best of a partial hand and the new board combinations
 		PokerHandHigh(const PokerHandHigh& other) : m_hand_rank(other.m_hand_rank) 
 		{ 
 			m_rank_name = other.m_rank_name; 
@@ -298,10 +440,16 @@ namespace Poker
 	class PokerHandLow : public PokerHand
 	{
 		bool m_qualified;
+
+		void Consider(PokerCardArray);
+		void Evaluate(const PokerPlayerCards&, const PokerBoardPrepared&, PokerCardTripleArray::size_type);
+		void Qualify();
 	
 	public:
 
-		PokerHandLow(PokerPlayerCards, PokerBoardCards);
+		PokerHandLow(const PokerPlayerCards&, const PokerBoardCards&);
+		PokerHandLow(const PokerPlayerCards&, const PokerBoardPrepared&);
+		PokerHandLow(const PokerHandLow&, const PokerPlayerCards&, const PokerBoardPrepared&); // best of a partial hand and the new board combinations
 		PokerHandLow(const PokerHandLow& other) : m_qualified(other.m_qualified)
 		{ 
 			m_rank_name = other.m_rank_name; 
@@ -325,4 +473,8 @@ namespace Poker
 		{ return m_qualified && ( !rValue.qualified() || rValue.qualified() && m_cards < rValue.GetCards() ); }
 	};
 
+	// -------------------------------------------------------------------------------------------------------
+
+	int HandComparison(const PokerHand&, const PokerHand&); // 1: first hand wins, -1: second hand wins, 0: split or no hand qualified
+
 } // End Namespace Poker
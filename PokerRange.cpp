@@ -0,0 +1,283 @@
+#include "PokerRange.h"
+#include <unordered_map>
+#include <iomanip>
+#include <climits>
+#include <cmath>
+
+namespace Poker
+{
+
+// ------------------------------------- PokerRange --------------------------------------------------------
+
+PokerRange::PokerRange(const std::string& s)
+{
+	std::string::size_type pos1 = s.find(":"), pos2;
+	if ( pos1 == std::string::npos )
+		pos1 = 0;
+	else
+		m_set_name = s.substr(0, pos1++);
+
+	while ( pos1 < s.length() )
+	{
+		if ( (pos2 = s.find(",", pos1)) == std::string::npos )
+			pos2 = s.length();
+
+		std::string item = s.substr(pos1, pos2-pos1);
+		double weight = 1;
+		std::string::size_type at = item.find("@");
+		if ( at != std::string::npos )
+		{
+			const char* p = item.c_str() + at + 1;
+			char* end = nullptr;
+			weight = strtod(p, &end);
+			if ( end == p || *end ) weight = 0; // not a number, rejected by IsValid()
+			item.resize(at);
+		}
+		if ( !item.empty() || at != std::string::npos )
+			m_hands.push_back( PokerRangeHand(PokerPlayerCards(item), weight) );
+		pos1 = pos2 + 1;
+	}
+}
+
+bool PokerRange::IsValid() const
+{
+	if ( m_hands.empty() ) return false;
+	for(PokerRangeHandArray::size_type i = 0; i < m_hands.size(); i++)
+	{
+		const PokerRangeHand& h = m_hands[i];
+		if ( h.GetCards().Cards() != 4 || !h.GetCards().IsValid() || !(h.GetWeight() > 0) || !std::isfinite(h.GetWeight()) )
+			return false;
+	}
+	return true;
+}
+
+std::string PokerRange::ToString() const
+{
+	std::ostringstream oss;
+	if ( !m_set_name.empty() )
+		oss << m_set_name << ':';
+	for(PokerRangeHandArray::size_type i = 0; i < m_hands.size(); i++)
+	{
+		if ( i ) oss << ',';
+		oss << m_hands[i].GetCards();
+		if ( m_hands[i].GetWeight() != 1 ) oss << '@' << m_hands[i].GetWeight();
+	}
+	return oss.str();
+}
+
+// ------------------------------------- PokerRangeEquity --------------------------------------------------
+
+std::string PokerRangeEquity::ToString() const
+{
+	if ( !m_pairs )
+		return "no compatible matchups";
+
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2)
+		<< "Hi " << HiEquity() * 100 << "%, "
+		<< "Lo " << LoEquity() * 100 << "% (no Lo " << NoLowRate() * 100 << "%), "
+		<< "Scoop " << ScoopRate() * 100 << "%, "
+		<< "Pot " << PotEquity() * 100 << "%";
+	return oss.str();
+}
+
+// ------------------------------------- Range vs Range ----------------------------------------------------
+
+/*	Every hand of both ranges is evaluated once against the board into a pair of strength keys
+	(Hi: larger is better; Lo: larger is better, 0 = not qualified). Each statistic for a hand of
+	the first range is then a weighted count of second-range hands with hi < x and lo < y, which is
+	answered by a sweep over hi with a Fenwick tree over lo. Card removal is handled by inclusion-
+	exclusion: second-range hands are also filed under every subset of their cards, and a query
+	subtracts/adds the counts of the buckets keyed by the subsets of its own cards.
+	The weighted sums only cancel up to rounding, so the sweep also counts the pairs of hands as
+	integers, which cancel exactly: a statistic with no pairs behind it is 0, others are clamped at 0.
+*/
+
+typedef unsigned long long CardMask;
+
+struct RangeKey { CardMask mask; unsigned int hi, lo; double weight; };
+struct DominancePoint { unsigned int hi, lo; double weight; };
+struct DominanceQuery { unsigned int hi, lo; int sign; std::size_t slot; };
+struct DominanceBucket { std::vector<DominancePoint> points; std::vector<DominanceQuery> queries; };
+
+static bool GetCardMask(const PokerCardSet& cs, CardMask& mask)
+{
+	mask = 0;
+	for(unsigned int i = 0; i < cs.Cards(); i++)
+	{
+		int n = cs[i].GetCardIndex();
+		if ( n < 0 || mask & (1ULL << n) ) return false;
+		mask |= 1ULL << n;
+	}
+	return true;
+}
+
+static bool OddCardCount(CardMask mask)
+{
+	bool odd = false;
+	for(; mask; mask &= mask - 1) odd = !odd;
+	return odd;
+}
+
+static unsigned int HighKey(const PokerHandHigh& h)
+{
+	unsigned int key = h.GetRank();
+	for(unsigned int i = 0; i < h.Cards(); i++)
+		key = key << 4 | h[i].GetCardRank();
+	return key;
+}
+
+static unsigned int LowKey(const PokerHandLow& h)
+{
+	if ( !h.qualified() ) return 0;
+	unsigned int key = 0;
+	for(unsigned int i = 0; i < h.Cards(); i++)
+		key = key << 4 | h[i].GetCardRank();
+	return (1u << 20) - key;
+}
+
+static void EvaluateRange(const PokerRange& r, const PokerBoardCards& b, CardMask board, std::vector<RangeKey>& keys)
+{
+	keys.reserve( r.Hands() );
+	for(PokerRangeHandArray::size_type i = 0; i < r.Hands(); i++)
+	{
+		const PokerRangeHand& h = r.GetHands()[i];
+		RangeKey k;
+		if ( h.GetCards().Cards() != 4 || h.GetWeight() <= 0 || !GetCardMask(h.GetCards(), k.mask) || k.mask & board )
+			continue;
+		k.hi = HighKey( PokerHandHigh(h.GetCards(), b) );
+		k.lo = LowKey( PokerHandLow(h.GetCards(), b) );
+		k.weight = h.GetWeight();
+		keys.push_back(k);
+	}
+}
+
+static void SweepBucket(DominanceBucket& bucket, std::vector<double>& result, std::vector<long long>& pairs)
+{
+	std::vector<DominancePoint>& points = bucket.points;
+	std::vector<DominanceQuery>& queries = bucket.queries;
+	sort(points.begin(), points.end(), [](const DominancePoint& x, const DominancePoint& y) { return x.hi < y.hi; });
+	sort(queries.begin(), queries.end(), [](const DominanceQuery& x, const DominanceQuery& y) { return x.hi < y.hi; });
+
+	std::vector<unsigned int> lo;
+	lo.reserve( points.size() );
+	for(std::size_t i = 0; i < points.size(); i++)
+		lo.push_back( points[i].lo );
+	sort(lo.begin(), lo.end());
+	lo.resize( distance(lo.begin(), unique(lo.begin(), lo.end())) );
+
+	std::vector<double> tree(lo.size() + 1, 0);
+	std::vector<long long> count(lo.size() + 1, 0);
+	std::size_t p = 0;
+	for(std::size_t q = 0; q < queries.size(); q++)
+	{
+		for(; p < points.size() && points[p].hi < queries[q].hi; p++)
+			for(std::size_t n = lower_bound(lo.begin(), lo.end(), points[p].lo) - lo.begin() + 1; n <= lo.size(); n += n & (0 - n))
+			{
+				tree[n] += points[p].weight;
+				count[n]++;
+			}
+
+		double sum = 0;
+		long long nSum = 0;
+		for(std::size_t n = lower_bound(lo.begin(), lo.end(), queries[q].lo) - lo.begin(); n; n -= n & (0 - n))
+		{
+			sum += tree[n];
+			nSum += count[n];
+		}
+		result[queries[q].slot] += queries[q].sign * sum;
+		pairs[queries[q].slot] += queries[q].sign * nSum;
+	}
+}
+
+PokerRangeEquity EvaluateRangeVsRange(const PokerRange& ra, const PokerRange& rb, const PokerBoardCards& b)
+{
+	PokerRangeEquity e;
+	CardMask board;
+	if ( b.Cards() != 5 || !GetCardMask(b, board) )
+		return e;
+
+	std::vector<RangeKey> ka, kb;
+	EvaluateRange(ra, b, board, ka);
+	EvaluateRange(rb, b, board, kb);
+
+	std::unordered_map<CardMask, DominanceBucket> buckets;
+	for(std::size_t i = 0; i < kb.size(); i++)
+	{
+		DominancePoint pt = { kb[i].hi, kb[i].lo, kb[i].weight };
+		for(CardMask sub = kb[i].mask; ; sub = (sub - 1) & kb[i].mask)
+		{
+			buckets[sub].points.push_back(pt);
+			if ( !sub ) break;
+		}
+	}
+
+	// Per hand of the first range: all, hi<, hi<=, lo<, lo<=, scoop, no-low hi<, no-low hi<=, no-low
+	const std::size_t slots = 9;
+	const unsigned int any = UINT_MAX;
+	std::vector<double> result(ka.size() * slots, 0);
+	std::vector<long long> pairs(ka.size() * slots, 0);
+	for(std::size_t i = 0; i < ka.size(); i++)
+	{
+		const unsigned int hi = ka[i].hi, lo = ka[i].lo;
+		const unsigned int bounds[slots][2] =
+		{
+			{ any, any }, { hi, any }, { hi + 1, any }, { any, lo }, { any, lo + 1 },
+			{ hi, lo ? lo : 1 }, { hi, 1 }, { hi + 1, 1 }, { any, 1 }
+		};
+
+		for(CardMask sub = ka[i].mask; ; sub = (sub - 1) & ka[i].mask)
+		{
+			std::unordered_map<CardMask, DominanceBucket>::iterator it = buckets.find(sub);
+			if ( it != buckets.end() )
+				for(std::size_t s = 0; s < slots; s++)
+				{
+					DominanceQuery q = { bounds[s][0], bounds[s][1], OddCardCount(sub) ? -1 : 1, i * slots + s };
+					it->second.queries.push_back(q);
+				}
+			if ( !sub ) break;
+		}
+	}
+
+	for(std::unordered_map<CardMask, DominanceBucket>::iterator it = buckets.begin(); it != buckets.end(); ++it)
+		if ( !it->second.queries.empty() )
+			SweepBucket(it->second, result, pairs);
+
+	for(std::size_t i = 0; i < ka.size(); i++)
+	{
+		const long long* n = &pairs[i * slots];
+		if ( !n[0] ) continue; // every hand of the second range shares a card with this one
+
+		double r[slots];
+		for(std::size_t s = 0; s < slots; s++)
+			r[s] = n[s] > 0 ? std::max(result[i * slots + s], 0.0) : 0;
+		auto between = [&](std::size_t lower, std::size_t upper) { return n[upper] > n[lower] ? std::max(r[upper] - r[lower], 0.0) : 0; };
+
+		const double w = ka[i].weight;
+		double hi_win = r[1], hi_tie = between(1, 2), lo_win = 0, lo_tie = 0, no_low = 0, no_low_hi = 0;
+		if ( ka[i].lo )
+		{
+			lo_win = r[3];
+			lo_tie = between(3, 4);
+		}
+		else
+		{
+			no_low = r[8];
+			no_low_hi = r[6] + between(6, 7) / 2;
+			e.m_no_low_pairs += n[8];
+		}
+
+		e.m_pairs += n[0];
+		e.m_matchups += w * r[0];
+		e.m_hi_win += w * hi_win;
+		e.m_hi_tie += w * hi_tie;
+		e.m_lo_win += w * lo_win;
+		e.m_lo_tie += w * lo_tie;
+		e.m_no_low += w * no_low;
+		e.m_scoop  += w * r[5];
+		e.m_pot += w * ( (hi_win + hi_tie / 2) + (lo_win + lo_tie / 2) + no_low_hi ) / 2;
+	}
+	return e;
+}
+
+} // End Namespace Poker
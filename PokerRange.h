@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Poker.h"
+
+namespace Poker
+{
+	// -------------------------------------------------------------------------------------------------------
+
+	class PokerRangeHand
+	{
+	protected:
+
+		PokerPlayerCards m_cards;
+		double m_weight;
+
+	public:
+
+		PokerRangeHand() : m_weight(0) { }
+		PokerRangeHand(const PokerPlayerCards& c, double w) : m_cards(c), m_weight(w) { }
+
+		const PokerPlayerCards& GetCards() const { return m_cards; }
+		double GetWeight() const { return m_weight; }
+	};
+
+	using PokerRangeHandArray = std::vector<PokerRangeHand>;
+
+	/* -------------------------------------------------------------------------------------------------------
+		Weighted list of holdings, e.g. "RangeA:Ac-Kc-Jc-3d@2,5c-As-Qs-7d".
+		Hands are separated by ',' and may carry an optional '@weight' (default 1).
+		IsValid() checks that every hand has 4 distinct valid cards and a positive weight.
+	*/
+
+	class PokerRange
+	{
+	protected:
+
+		PokerRangeHandArray m_hands;
+		std::string m_set_name;
+
+	public:
+
+		PokerRange() { }
+		PokerRange(const std::string&);
+
+		std::string GetName() const { return m_set_name; }
+		const PokerRangeHandArray& GetHands() const { return m_hands; }
+		unsigned int Hands() const { return m_hands.size(); }
+		bool IsValid() const;
+
+		virtual std::string ToString() const;
+	};
+
+	inline std::ostream& operator<<(std::ostream& out, const PokerRange& r) { return out << r.ToString(); }
+
+	/* -------------------------------------------------------------------------------------------------------
+		Weighted results for the first range over all card-compatible matchups.
+		Hi/Lo/scoop figures are sums of weight(A) * weight(B); the pot share counts a scoop as 1,
+		a Hi-only or Lo-only win as 1/2 and a split as half of that. The matchups are also counted
+		unweighted (exact), which decides whether there is anything to report.
+	*/
+
+	class PokerRangeEquity
+	{
+	public:
+
+		long long m_pairs, m_no_low_pairs; // unweighted matchups, in total and without a Lo
+		double m_matchups;
+		double m_hi_win, m_hi_tie;
+		double m_lo_win, m_lo_tie, m_no_low;
+		double m_scoop;
+		double m_pot;
+
+		PokerRangeEquity() : m_pairs(0), m_no_low_pairs(0), m_matchups(0), m_hi_win(0), m_hi_tie(0), m_lo_win(0), m_lo_tie(0), m_no_low(0), m_scoop(0), m_pot(0) { }
+
+		double HiEquity() const { return m_pairs ? (m_hi_win + m_hi_tie / 2) / m_matchups : 0; }
+		double LoEquity() const { return m_pairs > m_no_low_pairs ? (m_lo_win + m_lo_tie / 2) / (m_matchups - m_no_low) : 0; }
+		double NoLowRate() const { return m_pairs ? m_no_low / m_matchups : 0; }
+		double ScoopRate() const { return m_pairs ? m_scoop / m_matchups : 0; }
+		double PotEquity() const { return m_pairs ? m_pot / m_matchups : 0; }
+
+		std::string ToString() const; // "no compatible matchups" without any pair of hands
+	};
+
+	inline std::ostream& operator<<(std::ostream& out, const PokerRangeEquity& e) { return out << e.ToString(); }
+
+	// Expects valid ranges and a valid 5-card board (see IsValid()); hands that collide with the board
+	// are dropped and pairs of hands sharing a card are skipped.
+	PokerRangeEquity EvaluateRangeVsRange(const PokerRange&, const PokerRange&, const PokerBoardCards&);
+
+} // End Namespace Poker
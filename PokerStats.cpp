@@ -0,0 +1,126 @@
+#include "PokerStats.h"
+#include <iomanip>
+
+namespace Poker
+{
+
+// ------------------------------------- PokerDealStats ----------------------------------------------------
+
+PokerDealStats::PokerDealStats()
+{
+	for(unsigned int t = 0; t < textures; t++)
+	{
+		m_deals[t] = m_hi_splits[t] = m_lo_qualified[t] = m_lo_splits[t] = m_scoops_a[t] = m_scoops_b[t] = 0;
+		for(unsigned int r = 0; r < hi_ranks; r++)
+			m_hi_wins[t][r] = 0;
+	}
+}
+
+void PokerDealStats::Add(const PokerBoardPrepared& b, const PokerHandHigh& hi1, const PokerHandHigh& hi2, const PokerHandLow& lo1, const PokerHandLow& lo2)
+{
+	const PokerBoardCards& board = b.GetBoard();
+	bool texture[textures] = { true, false, false, false, !b.GetLowTriples().empty() };
+	unsigned int suits[5] = { 0, 0, 0, 0, 0 };
+	for(unsigned int i = 0; i < board.Cards(); i++)
+	{
+		unsigned int n = ++suits[static_cast<int>(board[i].GetSuit())];
+		if ( n >= 3 && board[i].HasSuit() )
+			texture[texture_flush_possible] = true;
+		if ( n == board.Cards() && board[i].HasSuit() )
+			texture[texture_monotone] = true;
+		for(unsigned int j = i + 1; j < board.Cards(); j++)
+			if ( board[i].GetCardRank() == board[j].GetCardRank() )
+				texture[texture_paired] = true;
+	}
+
+	// 1: HandA wins, -1: HandB wins, 0: split (or no low for Lo)
+	int hi = HandComparison(hi1, hi2);
+	bool low = lo1.qualified() || lo2.qualified();
+	int lo = HandComparison(lo1, lo2);
+	bool scoop = hi && ( !low || lo == hi );
+	unsigned int rank = ( hi < 0 ? hi2 : hi1 ).GetRank();
+
+	for(unsigned int t = 0; t < textures; t++)
+		if ( texture[t] )
+		{
+			m_deals[t]++;
+			if ( hi )
+				m_hi_wins[t][rank < hi_ranks ? rank : 0]++;
+			else
+				m_hi_splits[t]++;
+			if ( low ) m_lo_qualified[t]++;
+			if ( low && !lo ) m_lo_splits[t]++;
+			if ( scoop && hi > 0 ) m_scoops_a[t]++;
+			if ( scoop && hi < 0 ) m_scoops_b[t]++;
+		}
+}
+
+PokerDealStats& PokerDealStats::operator += (const PokerDealStats& rValue)
+{
+	for(unsigned int t = 0; t < textures; t++)
+	{
+		m_deals[t] += rValue.m_deals[t];
+		m_hi_splits[t] += rValue.m_hi_splits[t];
+		m_lo_qualified[t] += rValue.m_lo_qualified[t];
+		m_lo_splits[t] += rValue.m_lo_splits[t];
+		m_scoops_a[t] += rValue.m_scoops_a[t];
+		m_scoops_b[t] += rValue.m_scoops_b[t];
+		for(unsigned int r = 0; r < hi_ranks; r++)
+			m_hi_wins[t][r] += rValue.m_hi_wins[t][r];
+	}
+	return *this;
+}
+
+std::string PokerDealStats::GetTextureName(unsigned int n)
+{
+	switch( n )
+	{
+		case texture_all:            return "All boards"; break;
+		case texture_paired:         return "Paired"; break;
+		case texture_flush_possible: return "Flush possible"; break;
+		case texture_monotone:       return "Monotone"; break;
+		case texture_three_low:      return "Three low"; break;
+		default: return "Unknown texture"; break;
+	}
+}
+
+std::string PokerDealStats::ToString() const
+{
+	const int nLabel = 26, nColumn = 22;
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2) << std::left << std::setw(nLabel) << "";
+	for(unsigned int t = 0; t < textures; t++)
+		oss << std::right << std::setw(nColumn) << GetTextureName(t);
+	oss << std::endl;
+
+	auto row = [&](const std::string& label, const unsigned long long* counts)
+	{
+		oss << std::left << std::setw(nLabel) << label;
+		for(unsigned int t = 0; t < textures; t++)
+		{
+			std::ostringstream cell;
+			cell << std::fixed << std::setprecision(2) << counts[t];
+			if ( counts != m_deals )
+				cell << " (" << ( m_deals[t] ? 100.0 * counts[t] / m_deals[t] : 0.0 ) << "%)";
+			oss << std::right << std::setw(nColumn) << cell.str();
+		}
+		oss << std::endl;
+	};
+
+	row("Deals", m_deals);
+	for(unsigned int r = hi_ranks - 1; r > 0; r--)
+	{
+		unsigned long long counts[textures];
+		for(unsigned int t = 0; t < textures; t++)
+			counts[t] = m_hi_wins[t][r];
+		row("Hi won by " + PokerHandHigh::GetRankNameForHighHand(r), counts);
+	}
+	row("Hi split", m_hi_splits);
+	row("Lo qualified", m_lo_qualified);
+	row("Lo split", m_lo_splits);
+	row("HandA scoop", m_scoops_a);
+	row("HandB scoop", m_scoops_b);
+	return oss.str();
+}
+
+} // End Namespace Poker
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Poker.h"
+
+namespace Poker
+{
+	/* -------------------------------------------------------------------------------------------------------
+		Aggregated results of many deals, broken down by board texture:
+		Paired         - at least two board cards of the same rank
+		Flush possible - at least three board cards of one suit
+		Monotone       - all board cards of one suit
+		Three low      - at least three different board ranks 8 or lower (a low is possible)
+		Counters are plain integers, so keep one object per thread and merge them with +=. Objects are
+		cache line aligned so that the counters of different threads never share a line.
+	*/
+
+	class alignas(64) PokerDealStats
+	{
+	public:
+
+		enum Texture { texture_all, texture_paired, texture_flush_possible, texture_monotone, texture_three_low, textures };
+		enum { hi_ranks = 10 }; // PokerHandHigh::GetRank() 0..9
+
+		unsigned long long m_deals[textures];
+		unsigned long long m_hi_wins[textures][hi_ranks]; // by the rank of the winning High hand
+		unsigned long long m_hi_splits[textures];
+		unsigned long long m_lo_qualified[textures];
+		unsigned long long m_lo_splits[textures];
+		unsigned long long m_scoops_a[textures]; // HandA wins both halves (or High with no Lo)
+		unsigned long long m_scoops_b[textures];
+
+		PokerDealStats();
+
+		void Add(const PokerBoardPrepared&, const PokerHandHigh&, const PokerHandHigh&, const PokerHandLow&, const PokerHandLow&);
+		PokerDealStats& operator += (const PokerDealStats&);
+
+		static std::string GetTextureName(unsigned int);
+		std::string ToString() const;
+	};
+
+	inline std::ostream& operator<<(std::ostream& out, const PokerDealStats& s) { return out << s.ToString(); }
+
+} // End Namespace Poker
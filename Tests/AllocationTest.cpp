@@ -0,0 +1,85 @@
+#include "../Poker.h"
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+/*	Counts heap allocations while deals are evaluated: preparing a board, evaluating hands against
+	it (full and by extending a flop/turn board), evaluating against plain board cards and comparing
+	the hands must not allocate. Set names are included on purpose, short ones and ones longer than
+	the small-string buffer, since only the cards are copied during the evaluation.
+	Returns EXIT_FAILURE if anything was allocated or the prepared and plain board evaluations differ.
+*/
+
+static unsigned long long g_allocations = 0;
+
+void* operator new(std::size_t n)
+{
+	++g_allocations;
+	void* p = std::malloc(n ? n : 1);
+	if ( !p ) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+static bool SameLow(const Poker::PokerHandLow& x, const Poker::PokerHandLow& y)
+{
+	return x.qualified() == y.qualified() && ( !x.qualified() || x == y );
+}
+
+// Number of hands whose evaluation depends on the path taken
+static unsigned int EvaluateDeal(const Poker::PokerPlayerCards& p1, const Poker::PokerPlayerCards& p2, 
+								 const Poker::PokerBoardCards& flop, const Poker::PokerBoardCards& b)
+{
+	Poker::PokerBoardPrepared pb(b), pf(flop), pt(pf, b[3]), pr(pt, b[4]);
+	Poker::PokerHandHigh hi1(p1, pb), hi2(p2, pb);
+	Poker::PokerHandLow lo1(p1, pb), lo2(p2, pb);
+
+	Poker::PokerHandHigh bhi1(p1, b), bhi2(p2, b);
+	Poker::PokerHandLow blo1(p1, b), blo2(p2, b);
+
+	Poker::PokerHandHigh fhi1(p1, pf), fhi2(p2, pf), thi1(fhi1, p1, pt), thi2(fhi2, p2, pt), rhi1(thi1, p1, pr), rhi2(thi2, p2, pr);
+	Poker::PokerHandLow flo1(p1, pf), flo2(p2, pf), tlo1(flo1, p1, pt), tlo2(flo2, p2, pt), rlo1(tlo1, p1, pr), rlo2(tlo2, p2, pr);
+
+	return ( bhi1 == hi1 ? 0 : 1 ) + ( bhi2 == hi2 ? 0 : 1 ) + ( rhi1 == hi1 ? 0 : 1 ) + ( rhi2 == hi2 ? 0 : 1 ) +
+		   ( SameLow(blo1, lo1) ? 0 : 1 ) + ( SameLow(blo2, lo2) ? 0 : 1 ) + 
+		   ( SameLow(rlo1, lo1) ? 0 : 1 ) + ( SameLow(rlo2, lo2) ? 0 : 1 );
+}
+
+int main()
+{
+	const char* deals[][3] =
+	{
+		{ "HandA:Ac-Kc-Jc-3d", "HandB:5c-As-Qs-7d", "Board:Js-Ks-Tc-Ts-Qc" },
+		{ "HandA:Ah-2s-Qd-9s", "HandB:Ac-3d-6s-Jh", "Board:Kd-4h-5c-8d-Ks" },
+		{ "PlayerOneHoleCards:Ah-2s-Qd-9s", "PlayerTwoHoleCards:Ac-3d-6s-Jh", "CommunityBoardCards:Kd-4h-5c-8d-Ks" },
+		{ "PlayerOneHoleCards:2h-3h-4c-5d", "PlayerTwoHoleCards:Ad-2d-7s-7c", "CommunityBoardCards:6h-7h-8h-9h-Th" }
+	};
+	const unsigned int nDeals = sizeof(deals) / sizeof(deals[0]);
+
+	Poker::PokerPlayerCards p1[nDeals], p2[nDeals];
+	Poker::PokerBoardCards b[nDeals], flop[nDeals];
+	for(unsigned int i = 0; i < nDeals; i++) // parsing may allocate, it is not counted
+	{
+		std::string sBoard(deals[i][2]);
+		p1[i] = Poker::PokerPlayerCards(deals[i][0]);
+		p2[i] = Poker::PokerPlayerCards(deals[i][1]);
+		b[i] = Poker::PokerBoardCards(sBoard);
+		flop[i] = Poker::PokerBoardCards(sBoard.substr(0, sBoard.length() - 6)); // without "-Xx-Xx"
+	}
+
+	unsigned int nMismatches = 0;
+	unsigned long long nBefore = g_allocations;
+	for(unsigned int n = 0; n < 100; n++)
+		for(unsigned int i = 0; i < nDeals; i++)
+			nMismatches += EvaluateDeal(p1[i], p2[i], flop[i], b[i]);
+	unsigned long long nAllocations = g_allocations - nBefore;
+
+	std::cout << "Allocations during evaluation: " << nAllocations << std::endl;
+	std::cout << "Evaluation mismatches: " << nMismatches << std::endl;
+	return nAllocations || nMismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
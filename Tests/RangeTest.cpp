@@ -0,0 +1,128 @@
+#include "../PokerRange.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+
+/*	Checks EvaluateRangeVsRange against a pair-by-pair evaluation of random problems, and that
+	problems whose matchups are all blocked by shared cards report no matchups at all, whatever
+	the weights (the weighted card-removal sums only cancel up to rounding).
+	Returns EXIT_FAILURE on any difference.
+*/
+
+static std::string CardName(int n)
+{
+	return std::string(1, "23456789TJQKA"[n / 4]) + "dchs"[n % 4];
+}
+
+static unsigned long long CardMask(const Poker::PokerCardSet& cs)
+{
+	unsigned long long mask = 0;
+	for(unsigned int i = 0; i < cs.Cards(); i++)
+		mask |= 1ULL << cs[i].GetCardIndex();
+	return mask;
+}
+
+static Poker::PokerRangeEquity EvaluatePairs(const Poker::PokerRange& ra, const Poker::PokerRange& rb, const Poker::PokerBoardCards& b)
+{
+	Poker::PokerRangeEquity e;
+	const unsigned long long board = CardMask(b);
+	for(const Poker::PokerRangeHand& ha : ra.GetHands())
+		for(const Poker::PokerRangeHand& hb : rb.GetHands())
+		{
+			const unsigned long long ma = CardMask(ha.GetCards()), mb = CardMask(hb.GetCards());
+			if ( ma & board || mb & board || ma & mb )
+				continue;
+
+			const double w = ha.GetWeight() * hb.GetWeight();
+			const int hi = Poker::HandComparison(Poker::PokerHandHigh(ha.GetCards(), b), Poker::PokerHandHigh(hb.GetCards(), b));
+			Poker::PokerHandLow lo1(ha.GetCards(), b), lo2(hb.GetCards(), b);
+			const bool low = lo1.qualified() || lo2.qualified();
+			const int lo = Poker::HandComparison(lo1, lo2);
+			const double hi_share = hi > 0 ? 1 : hi ? 0 : 0.5, lo_share = lo > 0 ? 1 : lo ? 0 : 0.5;
+
+			e.m_pairs++;
+			e.m_matchups += w;
+			e.m_hi_win += hi > 0 ? w : 0;
+			e.m_hi_tie += hi ? 0 : w;
+			if ( low )
+			{
+				e.m_lo_win += lo > 0 ? w : 0;
+				e.m_lo_tie += lo ? 0 : w;
+			}
+			else
+			{
+				e.m_no_low_pairs++;
+				e.m_no_low += w;
+			}
+			e.m_scoop += hi > 0 && ( !low || lo > 0 ) ? w : 0;
+			e.m_pot += w * ( low ? (hi_share + lo_share) / 2 : hi_share );
+		}
+	return e;
+}
+
+static bool Same(const Poker::PokerRangeEquity& x, const Poker::PokerRangeEquity& y)
+{
+	auto close = [](double a, double b) { return std::fabs(a - b) < 1e-9; };
+	return x.m_pairs == y.m_pairs && x.m_no_low_pairs == y.m_no_low_pairs && x.ToString() == y.ToString() &&
+		   close(x.HiEquity(), y.HiEquity()) && close(x.LoEquity(), y.LoEquity()) && close(x.NoLowRate(), y.NoLowRate()) &&
+		   close(x.ScoopRate(), y.ScoopRate()) && close(x.PotEquity(), y.PotEquity());
+}
+
+int main()
+{
+	unsigned int nFailures = 0;
+	auto check = [&](const std::string& sa, const std::string& sb, const std::string& sBoard, bool bBlocked)
+	{
+		Poker::PokerRange ra(sa), rb(sb);
+		Poker::PokerBoardCards b(sBoard);
+		Poker::PokerRangeEquity e = Poker::EvaluateRangeVsRange(ra, rb, b), x = EvaluatePairs(ra, rb, b);
+		if ( !Same(e, x) || ( bBlocked && ( e.m_pairs || e.m_matchups || e.ToString() != "no compatible matchups" ) ) )
+		{
+			if ( nFailures++ < 10 )
+				std::cout << sa << ' ' << sb << ' ' << sBoard << std::endl << "  " << e << std::endl << "  expected " << x << std::endl;
+		}
+	};
+
+	check("RangeA:5s-2h-7s-Ks", "RangeB:Ks-7d-7c-Js@0.833,5s-8h-Th-Ts@0.920,Ks-3d-9c-Kh@0.119,2h-Td-2c-Tc@0.688,"
+		  "2h-5h-8s-8d@0.074,Ks-9s-5c-Js@0.211,7s-Td-9s-8c@0.656", "Board:Ad-Ac-Qd-Qh-4c", true);
+
+	std::mt19937 g(2026);
+	std::uniform_real_distribution<double> weight(0.001, 1);
+	for(unsigned int n = 0; n < 2000; n++)
+	{
+		std::vector<int> deck(52);
+		for(int i = 0; i < 52; i++) deck[i] = i;
+		std::shuffle(deck.begin(), deck.end(), g);
+
+		std::string sBoard = "Board:";
+		for(int i = 0; i < 5; i++) sBoard += ( i ? "-" : "" ) + CardName(deck[i]);
+
+		// Blocked problems: one hand against hands that each share one of its cards;
+		// otherwise random hands drawn from a few cards so that many pairs collide.
+		const bool bBlocked = n % 2 == 0;
+		std::string sa = "RangeA:", sb = "RangeB:";
+		for(int c = 0; c < 4; c++) sa += ( c ? "-" : "" ) + CardName(deck[5 + c]);
+		for(unsigned int h = 0, nHands = 2 + g() % 30; h < nHands; h++)
+		{
+			std::vector<int> cards(deck.begin() + 9, deck.begin() + 21);
+			std::shuffle(cards.begin(), cards.end(), g);
+			if ( bBlocked ) cards[0] = deck[5 + g() % 4];
+
+			std::string hand;
+			for(int c = 0; c < 4; c++) hand += ( c ? "-" : "" ) + CardName(cards[c]);
+			sb += ( h ? "," : "" ) + hand + "@" + std::to_string(weight(g));
+			if ( !bBlocked && h < 10 )
+			{
+				std::shuffle(cards.begin(), cards.end(), g);
+				sa += ",";
+				for(int c = 0; c < 4; c++) sa += ( c ? "-" : "" ) + CardName(cards[c]);
+				sa += "@" + std::to_string(weight(g));
+			}
+		}
+		check(sa, sb, sBoard, bBlocked);
+	}
+
+	std::cout << "Range evaluation failures: " << nFailures << std::endl;
+	return nFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}